@@ -5,11 +5,13 @@
 #define _LLP_AST_H
 
 #include <inttypes.h>
+#include <stdbool.h>
+#include <stddef.h>
 #include <stdio.h>
 
 struct AST {
     enum AST_type {
-        AST_BINOP, AST_UNOP, AST_LIT
+        AST_BINOP, AST_UNOP, AST_LIT, AST_VAR
     } type;
     union {
         struct binop {
@@ -32,18 +34,37 @@ struct AST {
             } type;
             struct AST *operand;
         } as_unop;
+        // Integer domains read value, the double domain reads real;
+        // a decimal literal's value is real truncated toward zero
         struct literal {
             int64_t value;
+            double real;
         } as_literal;
+        struct variable {
+            size_t index;
+        } as_var;
     };
 };
 
 struct AST *newnode(struct AST ast);
 
+void free_ast(struct AST *ast);
+
 struct AST _lit(int64_t value);
 
 struct AST *lit(int64_t value);
 
+struct AST _real(double value);
+
+struct AST *real(double value);
+
+// Truncates toward zero, saturating outside the int64_t range
+int64_t truncate_real(double value);
+
+struct AST _var(size_t index);
+
+struct AST *var(size_t index);
+
 struct AST _unop(enum unop_type type, struct AST *operand);
 
 struct AST *unop(enum unop_type type, struct AST *operand);
@@ -83,7 +104,30 @@ DECLARE_UNOP(fact, FACT)
 void print_ast(FILE *f, struct AST *ast);
 void ast_print(struct AST ast);
 
+int64_t factorial(int64_t n);
+int64_t impl(int64_t left, int64_t right);
+int64_t bicond(int64_t left, int64_t right);
+
 int64_t calc_ast(struct AST *ast);
+// `$i` is vars[i], or 0 when i >= vars_count
+int64_t calc_ast_vars(struct AST *ast, const int64_t *vars, size_t vars_count);
+
+// Same tree in another value domain: double has real `/`, fmod and gamma factorial.
+// Variables are bound in the domain's own type
+int32_t calc_ast_int32(struct AST *ast, const int32_t *vars, size_t vars_count);
+int64_t calc_ast_int64(struct AST *ast, const int64_t *vars, size_t vars_count);
+double calc_ast_double(struct AST *ast, const double *vars, size_t vars_count);
+bool calc_ast_boolean(struct AST *ast, const bool *vars, size_t vars_count);
+
+// One operator of a domain applied to already computed operands, `&&` and `||` included
+int32_t calc_unop_int32(enum unop_type type, int32_t operand);
+int64_t calc_unop_int64(enum unop_type type, int64_t operand);
+double calc_unop_double(enum unop_type type, double operand);
+bool calc_unop_boolean(enum unop_type type, bool operand);
+int32_t calc_binop_int32(enum binop_type type, int32_t left, int32_t right);
+int64_t calc_binop_int64(enum binop_type type, int64_t left, int64_t right);
+double calc_binop_double(enum binop_type type, double left, double right);
+bool calc_binop_boolean(enum binop_type type, bool left, bool right);
 void p_print_ast(FILE *f, struct AST *ast);
 
 #endif
@@ -5,7 +5,10 @@
 #ifndef TOKENIZER_C_BUILDER_H
 #define TOKENIZER_C_BUILDER_H
 
+#include "tokenizer.h"
+
 struct AST* build_ast(char *str);
+struct AST* build_ast_tokens(struct ring_token *tokens);
 
 
 #endif //TOKENIZER_C_BUILDER_H
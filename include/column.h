@@ -0,0 +1,34 @@
+/* column.h */
+
+#pragma once
+#ifndef _LLP_COLUMN_H_
+#define _LLP_COLUMN_H_
+
+#include <stdbool.h>
+
+#include "ast.h"
+
+// Rows evaluated per block: a few blocks of intermediates stay in L1/L2
+#define COLUMN_BLOCK 2048
+
+// Variable `$i` is bound to data[i][row]
+struct columns {
+    size_t rows;
+    size_t count;
+    int64_t **data;
+};
+
+// Evaluates ast for every row, writes cols->rows values to out.
+// Every node runs in the narrowest lane interval analysis proves safe for the column bounds.
+// Lanes where `&&`/`||` skip the right operand in calc_ast never trap in `/`, `%` or `!`.
+void calc_ast_columns(struct AST *ast, const struct columns *cols, int64_t *out);
+
+// CSV: one row per line, comma-separated integers, optional header line
+bool load_csv_columns(FILE *f, struct columns *cols);
+
+// Binary: uint64_t rows, uint64_t count, then count columns of rows int64_t
+bool load_bin_columns(FILE *f, struct columns *cols);
+
+void free_columns(struct columns *cols);
+
+#endif
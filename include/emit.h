@@ -0,0 +1,14 @@
+/* emit.h */
+
+#pragma once
+#ifndef _LLP_EMIT_H_
+#define _LLP_EMIT_H_
+
+#include "ast.h"
+
+// Writes a C translation unit: `static inline int64_t f_N(const int64_t *vars)`
+// for asts[N] with calc_ast_vars semantics, the external `formulas` table
+// and `formula_eval(id, vars)`, which returns 0 for an id past formulas_count
+void emit_c(FILE *f, struct AST **asts, size_t count);
+
+#endif
@@ -0,0 +1,50 @@
+/* intern.h */
+
+#pragma once
+#ifndef _LLP_INTERN_H_
+#define _LLP_INTERN_H_
+
+#include <stdbool.h>
+
+#include "ast.h"
+
+// Node ids are assigned after the children's, so ids are a topological order
+struct intern_node {
+    uint8_t type, op;
+    union {
+        struct {
+            uint32_t left, right;
+        } children;
+        // Literal value or variable index, also the key of both children at once
+        int64_t value;
+    };
+};
+
+struct intern_store {
+    struct intern_node *nodes;
+    size_t count, capacity;
+    // Open addressing by node, holds id + 1, 0 is empty
+    uint32_t *table;
+    size_t table_size;
+    // Tree nodes passed to intern_ast before deduplication
+    size_t seen;
+    // Memoized values are valid while stamps[id] == epoch
+    int64_t *values;
+    uint32_t *stamps;
+    uint32_t epoch;
+};
+
+void intern_init(struct intern_store *store);
+void intern_free(struct intern_store *store);
+
+// Returns the id of the unique node equal to ast
+uint32_t intern_ast(struct intern_store *store, struct AST *ast);
+
+// Evaluates roots for one binding set; every distinct node is computed at most once.
+// `$i` is vars[i], or 0 when i >= vars_count
+void intern_eval(struct intern_store *store, const uint32_t *roots, size_t count,
+                 const int64_t *vars, size_t vars_count, int64_t *out);
+
+void intern_print_stats(FILE *f, const struct intern_store *store);
+
+#endif
@@ -0,0 +1,13 @@
+/* pipeline.h */
+
+#pragma once
+#ifndef _LLP_PIPELINE_H_
+#define _LLP_PIPELINE_H_
+
+#include <stdio.h>
+
+// Tokenizes, builds, evaluates and formats every line of in on dedicated threads,
+// writes `<RPN> = <value>` lines to out and per-queue counters to stats
+int run_pipeline(FILE *in, FILE *out, FILE *stats);
+
+#endif
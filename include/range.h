@@ -0,0 +1,33 @@
+/* range.h */
+
+#pragma once
+#ifndef _LLP_RANGE_H_
+#define _LLP_RANGE_H_
+
+#include <stdbool.h>
+
+#include "ast.h"
+
+// Narrowest integer type that holds every value of a node
+enum range_width {
+    WIDTH_BOOL, WIDTH_INT16, WIDTH_INT32, WIDTH_INT64
+};
+
+struct range {
+    int64_t lo, hi;
+    // The node itself may overflow, divide by zero or recurse forever in factorial
+    bool overflow;
+    enum range_width width;
+};
+
+struct range range_of(int64_t lo, int64_t hi);
+
+// Bounds of one operator's result from the bounds of its operands
+struct range range_unop(enum unop_type type, struct range operand);
+struct range range_binop(enum binop_type type, struct range left, struct range right);
+
+// Bounds of the values of ast, not of its intermediates.
+// vars[i] bounds `$i`; variables past count are unbounded
+struct range ast_range(struct AST *ast, const struct range *vars, size_t count);
+
+#endif
@@ -0,0 +1,163 @@
+/* spsc.h */
+
+#pragma once
+#ifndef _LLP_SPSC_H_
+#define _LLP_SPSC_H_
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdlib.h>
+
+#define CACHE_LINE 64
+#define SPSC_SPINS 64
+
+// Bounded lock-free single-producer/single-consumer queue, capacity is a power of two.
+// Positions are published once per batch; producer and consumer fields
+// live on separate cache lines, and so does every slot.
+// occupancy / samples is the average backlog the consumer finds on refresh.
+// A side that finds the queue full or empty yields SPSC_SPINS times, then sleeps
+// on the condition variable until the other side publishes its position.
+#define DECLARE_SPSC(name, type)                                     \
+struct spsc_##name##_slot {                                          \
+  _Alignas(CACHE_LINE) type value;                                   \
+};                                                                   \
+struct spsc_##name {                                                 \
+  _Alignas(CACHE_LINE) atomic_size_t tail;                           \
+  size_t local_tail, cached_head;                                    \
+  size_t producer_stalls;                                            \
+  _Alignas(CACHE_LINE) atomic_size_t head;                           \
+  size_t local_head, cached_tail;                                    \
+  size_t consumer_stalls, occupancy, samples;                        \
+  _Alignas(CACHE_LINE) size_t capacity, batch;                       \
+  struct spsc_##name##_slot *slots;                                  \
+  atomic_bool producer_waiting, consumer_waiting;                    \
+  pthread_mutex_t lock;                                              \
+  pthread_cond_t wake;                                               \
+};
+
+#define DEFINE_SPSC(name, type)                                      \
+static bool spsc_##name##_init(struct spsc_##name *q,                \
+                               size_t capacity, size_t batch)        \
+{                                                                    \
+  *q = (struct spsc_##name) {0};                                     \
+  q->capacity = capacity;                                            \
+  q->batch = batch;                                                  \
+  q->slots = aligned_alloc(CACHE_LINE,                               \
+      capacity * sizeof(struct spsc_##name##_slot));                 \
+  pthread_mutex_init(&q->lock, NULL);                                \
+  pthread_cond_init(&q->wake, NULL);                                 \
+  return q->slots != NULL;                                           \
+}                                                                    \
+static void spsc_##name##_free(struct spsc_##name *q)                \
+{                                                                    \
+  free(q->slots);                                                    \
+  q->slots = NULL;                                                   \
+  pthread_mutex_destroy(&q->lock);                                   \
+  pthread_cond_destroy(&q->wake);                                    \
+}                                                                    \
+/* Pairs with the seq_cst store of *waiting in the sleeper */        \
+static void spsc_##name##_wake(struct spsc_##name *q,                \
+                               atomic_bool *waiting)                 \
+{                                                                    \
+  atomic_thread_fence(memory_order_seq_cst);                         \
+  if (atomic_load_explicit(waiting, memory_order_relaxed))           \
+  {                                                                  \
+    pthread_mutex_lock(&q->lock);                                    \
+    pthread_cond_broadcast(&q->wake);                                \
+    pthread_mutex_unlock(&q->lock);                                  \
+  }                                                                  \
+}                                                                    \
+static void spsc_##name##_flush(struct spsc_##name *q)               \
+{                                                                    \
+  atomic_store_explicit(&q->tail, q->local_tail,                     \
+                        memory_order_release);                       \
+  spsc_##name##_wake(q, &q->consumer_waiting);                       \
+}                                                                    \
+static void spsc_##name##_release(struct spsc_##name *q)             \
+{                                                                    \
+  atomic_store_explicit(&q->head, q->local_head,                     \
+                        memory_order_release);                       \
+  spsc_##name##_wake(q, &q->producer_waiting);                       \
+}                                                                    \
+/* Blocks while the queue is full */                                 \
+static void spsc_##name##_push(struct spsc_##name *q, type value)    \
+{                                                                    \
+  if (q->local_tail - q->cached_head == q->capacity)                 \
+  {                                                                  \
+    spsc_##name##_flush(q);                                          \
+    q->cached_head = atomic_load_explicit(&q->head,                  \
+                                          memory_order_acquire);     \
+    if (q->local_tail - q->cached_head == q->capacity)               \
+      q->producer_stalls++;                                          \
+    for (size_t spins = 0;                                           \
+         q->local_tail - q->cached_head == q->capacity; spins++)     \
+    {                                                                \
+      if (spins < SPSC_SPINS)                                        \
+        sched_yield();                                               \
+      else                                                           \
+      {                                                              \
+        pthread_mutex_lock(&q->lock);                                \
+        atomic_store(&q->producer_waiting, true);                    \
+        while (q->local_tail - atomic_load(&q->head) == q->capacity) \
+          pthread_cond_wait(&q->wake, &q->lock);                     \
+        atomic_store(&q->producer_waiting, false);                   \
+        pthread_mutex_unlock(&q->lock);                              \
+      }                                                              \
+      q->cached_head = atomic_load_explicit(&q->head,                \
+                                            memory_order_acquire);   \
+    }                                                                \
+  }                                                                  \
+  q->slots[q->local_tail & (q->capacity - 1)].value = value;         \
+  q->local_tail++;                                                   \
+  if (q->local_tail - atomic_load_explicit(&q->tail,                 \
+                                           memory_order_relaxed)     \
+      >= q->batch)                                                   \
+    spsc_##name##_flush(q);                                          \
+}                                                                    \
+static bool spsc_##name##_try_pop(struct spsc_##name *q, type *value) \
+{                                                                    \
+  if (q->local_head == q->cached_tail)                               \
+  {                                                                  \
+    spsc_##name##_release(q);                                        \
+    q->cached_tail = atomic_load_explicit(&q->tail,                  \
+                                          memory_order_acquire);     \
+    if (q->local_head == q->cached_tail)                             \
+      return false;                                                  \
+    q->occupancy += q->cached_tail - q->local_head;                  \
+    q->samples++;                                                    \
+  }                                                                  \
+  *value = q->slots[q->local_head & (q->capacity - 1)].value;        \
+  q->local_head++;                                                   \
+  if (q->local_head - atomic_load_explicit(&q->head,                 \
+                                           memory_order_relaxed)     \
+      >= q->batch)                                                   \
+    spsc_##name##_release(q);                                        \
+  return true;                                                       \
+}                                                                    \
+/* Blocks while the queue is empty */                                \
+static type spsc_##name##_pop(struct spsc_##name *q)                 \
+{                                                                    \
+  type value;                                                        \
+  if (spsc_##name##_try_pop(q, &value))                              \
+    return value;                                                    \
+  q->consumer_stalls++;                                              \
+  for (size_t spins = 0; !spsc_##name##_try_pop(q, &value); spins++) \
+  {                                                                  \
+    if (spins < SPSC_SPINS)                                          \
+      sched_yield();                                                 \
+    else                                                             \
+    {                                                                \
+      pthread_mutex_lock(&q->lock);                                  \
+      atomic_store(&q->consumer_waiting, true);                      \
+      while (atomic_load(&q->tail) == q->local_head)                 \
+        pthread_cond_wait(&q->wake, &q->lock);                       \
+      atomic_store(&q->consumer_waiting, false);                     \
+      pthread_mutex_unlock(&q->lock);                                \
+    }                                                                \
+  }                                                                  \
+  return value;                                                      \
+}
+
+#endif
@@ -31,6 +31,7 @@ struct token {
 
         // Non - reachable in a standard way
         TOK_LIT,
+        TOK_VAR,
         TOK_NEG,
 
         // Technical tokens
@@ -38,6 +39,8 @@ struct token {
         TOK_ERROR
     } type;
     int64_t value;
+    // Literal value as written, has a fraction or exponent only for decimal literals
+    double real;
 };
 
 DECLARE_RING(token, struct token)
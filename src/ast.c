@@ -1,5 +1,6 @@
 /* ast.c */
 
+#include <math.h>
 #include <stdlib.h>
 
 #include "../include/ast.h"
@@ -10,14 +11,49 @@ struct AST *newnode(struct AST ast) {
     return node;
 }
 
+void free_ast(struct AST *ast) {
+    if (ast == NULL)
+        return;
+    if (ast->type == AST_BINOP) {
+        free_ast(ast->as_binop.left);
+        free_ast(ast->as_binop.right);
+    } else if (ast->type == AST_UNOP)
+        free_ast(ast->as_unop.operand);
+    free(ast);
+}
+
 struct AST _lit(int64_t value) {
-    return (struct AST) {AST_LIT, .as_literal = {value}};
+    return (struct AST) {AST_LIT, .as_literal = {value, (double) value}};
 }
 
 struct AST *lit(int64_t value) {
     return newnode(_lit(value));
 }
 
+struct AST _real(double value) {
+    return (struct AST) {AST_LIT, .as_literal = {truncate_real(value), value}};
+}
+
+struct AST *real(double value) {
+    return newnode(_real(value));
+}
+
+int64_t truncate_real(double value) {
+    if (value >= 0x1p63)
+        return INT64_MAX;
+    if (value < -0x1p63)
+        return INT64_MIN;
+    return (int64_t) value;
+}
+
+struct AST _var(size_t index) {
+    return (struct AST) {AST_VAR, .as_var = {index}};
+}
+
+struct AST *var(size_t index) {
+    return newnode(_var(index));
+}
+
 struct AST _unop(enum unop_type type, struct AST *operand) {
     return (struct AST) {AST_UNOP, .as_unop = {type, operand}};
 }
@@ -66,12 +102,23 @@ static void print_unop(FILE *f, struct AST *ast) {
     fprintf(f, ")");
 }
 
+static void print_literal(FILE *f, struct literal literal) {
+    if (literal.real != (double) literal.value)
+        fprintf(f, "%.15g", literal.real);
+    else
+        fprintf(f, "%" PRId64, literal.value);
+}
+
 static void print_lit(FILE *f, struct AST *ast) {
-    fprintf(f, "%" PRId64, ast->as_literal.value);
+    print_literal(f, ast->as_literal);
+}
+
+static void print_var(FILE *f, struct AST *ast) {
+    fprintf(f, "$%zu", ast->as_var.index);
 }
 
 static printer *ast_printers[] = {
-        [AST_BINOP] = print_binop, [AST_UNOP] = print_unop, [AST_LIT] = print_lit};
+        [AST_BINOP] = print_binop, [AST_UNOP] = print_unop, [AST_LIT] = print_lit, [AST_VAR] = print_var};
 
 void print_ast(FILE *f, struct AST *ast) {
     if (ast)
@@ -84,103 +131,178 @@ void ast_print(struct AST ast) {
     print_ast(stdout, &ast);
 }
 
-typedef int64_t (parser)(struct AST *);
-
-// UNOP TYPE
-
-#define DEFINE_SIMPLE_UNOP_PARSER(unop, operation)        \
-static int64_t parse_unop_##unop(struct AST *operand) { \
-    return operation calc_ast(operand);      \
-}
-
-DEFINE_SIMPLE_UNOP_PARSER(neg, -)
-DEFINE_SIMPLE_UNOP_PARSER(negl, !)
-
-static int64_t factorial(int64_t n) {
+int64_t factorial(int64_t n) {
     return (n == 0) ? 1 : (n * factorial(n-1));
 }
 
-static int64_t parse_unop_fact(struct AST *ast) {
-    return factorial(calc_ast(ast));
+int64_t impl(int64_t left, int64_t right) {
+    return !left||right;
 }
 
-static parser *unop_parsers[] = {
-        [UN_NEG] = parse_unop_neg,
-        [UN_FACT] = parse_unop_fact,
-        [UN_NEGL] = parse_unop_negl
-};
-
-// BINOP TYPE
-
-typedef int64_t (binop_parser)(struct AST *, struct AST *);
-
-#define DEFINE_SIMPLE_BINOP_PARSER(binop, operation) \
-static int64_t parse_binop_##binop(struct AST *left, struct AST *right) { \
-    return calc_ast(left) operation calc_ast(right); \
+int64_t bicond(int64_t left, int64_t right) {
+    return (!left||right)&&(!right||left);
 }
 
-DEFINE_SIMPLE_BINOP_PARSER(add, +)
-DEFINE_SIMPLE_BINOP_PARSER(sub, -)
-DEFINE_SIMPLE_BINOP_PARSER(mul, *)
-DEFINE_SIMPLE_BINOP_PARSER(div, /)
-DEFINE_SIMPLE_BINOP_PARSER(mod, %)
-DEFINE_SIMPLE_BINOP_PARSER(and, &&)
-DEFINE_SIMPLE_BINOP_PARSER(or, ||)
+// DOMAIN OPERATIONS
 
-#undef DEFINE_SIMPLE_BINOP_PARSER
+// Literals, arithmetic, `%` and `!` depend on the domain, logical operators do not
 
-static int64_t impl(int64_t left, int64_t right) {
-    return !left||right;
-}
+#define DEFINE_NUMERIC_OPERATIONS(domain, value_type)                                          \
+static value_type add_##domain(value_type l, value_type r) { return l + r; }                   \
+static value_type subtract_##domain(value_type l, value_type r) { return l - r; }              \
+static value_type multiply_##domain(value_type l, value_type r) { return l * r; }              \
+static value_type divide_##domain(value_type l, value_type r) { return l / r; }                \
+static value_type negate_##domain(value_type n) { return -n; }
 
-static int64_t bicond(int64_t left, int64_t right) {
-    return (!left||right)&&(!right||left);
-}
+DEFINE_NUMERIC_OPERATIONS(int32, int32_t)
+DEFINE_NUMERIC_OPERATIONS(int64, int64_t)
+DEFINE_NUMERIC_OPERATIONS(double, double)
 
-static int64_t parse_binop_implication(struct AST *left, struct AST *right) {
-    return impl(calc_ast(left), calc_ast(right));
-}
+#undef DEFINE_NUMERIC_OPERATIONS
 
-static int64_t parse_binop_bicondition(struct AST *left, struct AST *right) {
-    return bicond(calc_ast(left), calc_ast(right));
-}
+static int32_t literal_int32(struct literal literal) { return (int32_t) literal.value; }
+static int32_t modulo_int32(int32_t left, int32_t right) { return left % right; }
+static int32_t factorial_int32(int32_t n) { return (int32_t) factorial(n); }
 
-static binop_parser *binop_parsers[] = {
-        [BIN_PLUS] = parse_binop_add,
-        [BIN_MINUS] = parse_binop_sub,
-        [BIN_DIV] = parse_binop_div,
-        [BIN_MUL] = parse_binop_mul,
-        [BIN_MOD] = parse_binop_mod,
-        [BIN_AND] = parse_binop_and,
-        [BIN_OR]  = parse_binop_or,
-        [BIN_IMPL] = parse_binop_implication,
-        [BIN_BIC] = parse_binop_bicondition
-};
+static int64_t literal_int64(struct literal literal) { return literal.value; }
+static int64_t modulo_int64(int64_t left, int64_t right) { return left % right; }
+static int64_t factorial_int64(int64_t n) { return factorial(n); }
 
-// AST TYPE
+// Largest n with n! representable in int64_t
+#define MAX_FACT 20
 
-static int64_t parse_lit(struct AST *ast) {
-    return ast->as_literal.value;
+static double literal_double(struct literal literal) { return literal.real; }
+static double modulo_double(double left, double right) { return fmod(left, right); }
+static double factorial_double(double n) {
+    if (n >= 0 && n <= MAX_FACT && n == floor(n))
+        return (double) factorial((int64_t) n);
+    return tgamma(n + 1);
 }
 
-static int64_t parse_unop(struct AST *ast) {
-    return unop_parsers[ast->as_unop.type](ast->as_unop.operand);
+#undef MAX_FACT
+
+// Literals and variables are true when nonzero; see "Value domains" in README.md
+static bool literal_boolean(struct literal literal) { return literal.real != 0; }
+static bool add_boolean(bool left, bool right) { return left || right; }
+static bool subtract_boolean(bool left, bool right) { return left != right; }
+static bool multiply_boolean(bool left, bool right) { return left && right; }
+// x / true == x, division by false gives false instead of trapping
+static bool divide_boolean(bool left, bool right) { return left && right; }
+// x % true == false, x % false == x
+static bool modulo_boolean(bool left, bool right) { return left && !right; }
+// -x is x, since x xor x == false
+static bool negate_boolean(bool n) { return n; }
+// 0! == 1! == 1
+static bool factorial_boolean(bool n) { return true; }
+
+// EVALUATOR TEMPLATE
+
+// One evaluator per value domain, no runtime type checks inside.
+// calc_unop_<domain> and calc_binop_<domain> are shared with the other scalar evaluators
+#define DEFINE_EVALUATOR(domain, value_type)                                                   \
+typedef value_type (domain##_unop)(value_type);                                                \
+typedef value_type (domain##_binop)(value_type, value_type);                                   \
+typedef value_type (domain##_parser)(struct AST *, const value_type *vars, size_t vars_count); \
+                                                                                               \
+static value_type domain##_negl(value_type operand) {                                          \
+    return !operand;                                                                           \
+}                                                                                              \
+                                                                                               \
+static domain##_unop *domain##_unops[] = {                                                     \
+        [UN_NEG] = negate_##domain,                                                            \
+        [UN_FACT] = factorial_##domain,                                                        \
+        [UN_NEGL] = domain##_negl                                                              \
+};                                                                                             \
+                                                                                               \
+static value_type domain##_and(value_type left, value_type right) {                            \
+    return left&&right;                                                                        \
+}                                                                                              \
+                                                                                               \
+static value_type domain##_or(value_type left, value_type right) {                             \
+    return left||right;                                                                        \
+}                                                                                              \
+                                                                                               \
+static value_type domain##_impl(value_type left, value_type right) {                           \
+    return !left||right;                                                                       \
+}                                                                                              \
+                                                                                               \
+static value_type domain##_bicond(value_type left, value_type right) {                         \
+    return (!left||right)&&(!right||left);                                                     \
+}                                                                                              \
+                                                                                               \
+static domain##_binop *domain##_binops[] = {                                                   \
+        [BIN_PLUS] = add_##domain,                                                             \
+        [BIN_MINUS] = subtract_##domain,                                                       \
+        [BIN_DIV] = divide_##domain,                                                           \
+        [BIN_MUL] = multiply_##domain,                                                         \
+        [BIN_MOD] = modulo_##domain,                                                           \
+        [BIN_AND] = domain##_and,                                                              \
+        [BIN_OR]  = domain##_or,                                                               \
+        [BIN_IMPL] = domain##_impl,                                                            \
+        [BIN_BIC] = domain##_bicond                                                            \
+};                                                                                             \
+                                                                                               \
+value_type calc_unop_##domain(enum unop_type type, value_type operand) {                       \
+    return domain##_unops[type](operand);                                                      \
+}                                                                                              \
+                                                                                               \
+value_type calc_binop_##domain(enum binop_type type, value_type left, value_type right) {      \
+    return domain##_binops[type](left, right);                                                 \
+}                                                                                              \
+                                                                                               \
+static value_type domain##_parse_lit(struct AST *ast,                                          \
+                                     const value_type *vars, size_t vars_count) {              \
+    return literal_##domain(ast->as_literal);                                                  \
+}                                                                                              \
+                                                                                               \
+static value_type domain##_parse_var(struct AST *ast,                                          \
+                                     const value_type *vars, size_t vars_count) {              \
+    return vars && ast->as_var.index < vars_count ? vars[ast->as_var.index] : 0;               \
+}                                                                                              \
+                                                                                               \
+static value_type domain##_parse_unop(struct AST *ast,                                         \
+                                      const value_type *vars, size_t vars_count) {             \
+    return calc_unop_##domain(ast->as_unop.type,                                               \
+                              calc_ast_##domain(ast->as_unop.operand, vars, vars_count));      \
+}                                                                                              \
+                                                                                               \
+/* The right operand of `&&` and `||` is skipped once the left one decides */                  \
+static value_type domain##_parse_binop(struct AST *ast,                                        \
+                                       const value_type *vars, size_t vars_count) {            \
+    const value_type left = calc_ast_##domain(ast->as_binop.left, vars, vars_count);           \
+    if (ast->as_binop.type == BIN_AND && !left)                                                \
+        return 0;                                                                              \
+    if (ast->as_binop.type == BIN_OR && left)                                                  \
+        return 1;                                                                              \
+    return calc_binop_##domain(ast->as_binop.type, left,                                       \
+                               calc_ast_##domain(ast->as_binop.right, vars, vars_count));      \
+}                                                                                              \
+                                                                                               \
+static domain##_parser *domain##_ast_parsers[] = {                                             \
+        [AST_LIT] = domain##_parse_lit, [AST_VAR] = domain##_parse_var,                        \
+        [AST_UNOP] = domain##_parse_unop, [AST_BINOP] = domain##_parse_binop                   \
+};                                                                                             \
+                                                                                               \
+value_type calc_ast_##domain(struct AST *ast, const value_type *vars, size_t vars_count) {     \
+    if (ast)                                                                                   \
+        return domain##_ast_parsers[ast->type](ast, vars, vars_count);                         \
+    else                                                                                       \
+        return 0;                                                                              \
 }
 
-static int64_t parse_binop(struct AST *ast) {
-    return binop_parsers[ast->as_binop.type](ast->as_binop.left, ast->as_binop.right);
-}
+DEFINE_EVALUATOR(int32, int32_t)
+DEFINE_EVALUATOR(int64, int64_t)
+DEFINE_EVALUATOR(double, double)
+DEFINE_EVALUATOR(boolean, bool)
 
-static parser *ast_parsers[] = {
-        [AST_LIT] = parse_lit, [AST_UNOP] = parse_unop, [AST_BINOP] = parse_binop
-};
+#undef DEFINE_EVALUATOR
 
+int64_t calc_ast_vars(struct AST *ast, const int64_t *vars, size_t vars_count) {
+    return calc_ast_int64(ast, vars, vars_count);
+}
 
 int64_t calc_ast(struct AST *ast) {
-    if (ast)
-        return ast_parsers[ast->type](ast);
-    else
-        return 0;
+    return calc_ast_int64(ast, NULL, 0);
 }
 
 
@@ -196,11 +318,16 @@ static void p_print_unop(FILE *f, struct AST *ast) {
 }
 
 static void p_print_lit(FILE *f, struct AST *ast) {
-    fprintf(f, "%"PRId64" ", ast->as_literal.value);
+    print_literal(f, ast->as_literal);
+    fprintf(f, " ");
+}
+
+static void p_print_var(FILE *f, struct AST *ast) {
+    fprintf(f, "$%zu ", ast->as_var.index);
 }
 
 static printer *ast_p_printers[] = {
-        [AST_BINOP] = p_print_binop, [AST_UNOP] = p_print_unop, [AST_LIT] = p_print_lit};
+        [AST_BINOP] = p_print_binop, [AST_UNOP] = p_print_unop, [AST_LIT] = p_print_lit, [AST_VAR] = p_print_var};
 
 void p_print_ast(FILE *f, struct AST *ast) {
     if (ast)
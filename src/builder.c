@@ -3,8 +3,14 @@
 #include "../include/ast.h"
 #include "../include/ring.h"
 #include "../include/tokenizer.h"
+#include "../include/builder.h"
 
-void token_print(struct token token) { printf("%s(%" PRId64 ")", TOKENS_STR[token.type], token.value); }
+void token_print(struct token token) {
+    if (token.type == TOK_LIT && token.real != (double) token.value)
+        printf("%s(%.15g)", TOKENS_STR[token.type], token.real);
+    else
+        printf("%s(%" PRId64 ")", TOKENS_STR[token.type], token.value);
+}
 
 DECLARE_RING(ast, struct AST)
 
@@ -53,20 +59,29 @@ static struct AST *build_unop(struct ring_ast **ast_build, struct token operator
 
 }
 
+// Integer literals have real == value exactly
 static struct AST *build_lit(struct ring_ast **ast_stack, struct token operator) {
+    if (operator.real != (double) operator.value)
+        return real(operator.real);
     return lit(operator.value);
 }
 
+static struct AST *build_var(struct ring_ast **ast_stack, struct token operator) {
+    return var(operator.value);
+}
+
 typedef struct AST *(builder)(struct ring_ast **ast_stack, struct token operator);
 
 static builder *builders[] = {
         [AST_UNOP] = build_unop,
         [AST_BINOP] = build_binop,
         [AST_LIT] = build_lit,
+        [AST_VAR] = build_var,
 };
 
 static size_t lit_to_ast_map(struct token tok) {
     if (tok.type == TOK_LIT) return AST_LIT;
+    if (tok.type == TOK_VAR) return AST_VAR;
     if (is_binop(tok)) return AST_BINOP;
     if (is_unop(tok)) return AST_UNOP;
     return -1;
@@ -100,11 +115,18 @@ struct AST *build_ast(char *str) {
 
     ring_token_print(tokens);
 
+    return build_ast_tokens(tokens);
+}
+
+struct AST *build_ast_tokens(struct ring_token *tokens) {
+    if (tokens == NULL)
+        return NULL;
+
     struct ring_ast *ast_stack = NULL;
     struct ring_token *ops_stack = NULL;
     while (tokens != NULL) {
         struct token tok = ring_token_pop_top(&tokens);
-        if (tok.type == TOK_LIT) {
+        if (tok.type == TOK_LIT || tok.type == TOK_VAR) {
             ring_ast_push(&ast_stack, *build_node(&ast_stack, tok));
         } else if (is_binop(tok) || is_unop(tok)) {
             while ((ops_stack != NULL) && (ast_stack != NULL) &&
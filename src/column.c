@@ -0,0 +1,423 @@
+/* column.c */
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/column.h"
+#include "../include/range.h"
+
+// Branch-free loops over restrict-qualified blocks, vectorized by GCC at -O3
+// (see the build files). Every lane type gets its own kernels: narrower lanes
+// fit more values per vector.
+// On x86-64 each kernel is also cloned for AVX2, picked at load time: the baseline
+// SSE2 has no 64-bit compares, so int64 logic and products would stay scalar.
+#if defined(__GNUC__) && defined(__x86_64__)
+#define KERNEL_TARGETS __attribute__((target_clones("avx2", "default")))
+#else
+#define KERNEL_TARGETS
+#endif
+
+#define DEFINE_BINOP_KERNEL(lane, value_type, binop, expression)                               \
+KERNEL_TARGETS                                                                                 \
+static void kernel_##lane##_binop_##binop(value_type *restrict left,                           \
+                                          const value_type *restrict right,                    \
+                                          const uint8_t *restrict active, size_t n) {          \
+    for (size_t i = 0; i < n; i++) {                                                           \
+        const value_type l = left[i], r = right[i];                                            \
+        left[i] = (expression);                                                                \
+    }                                                                                          \
+}
+
+#define DEFINE_UNOP_KERNEL(lane, value_type, unop, expression)                                 \
+KERNEL_TARGETS                                                                                 \
+static void kernel_##lane##_unop_##unop(value_type *restrict operand,                          \
+                                        const uint8_t *restrict active, size_t n) {            \
+    for (size_t i = 0; i < n; i++) {                                                           \
+        const value_type x = operand[i];                                                       \
+        operand[i] = (expression);                                                             \
+    }                                                                                          \
+}
+
+// Trapping operators: lanes a guarding `&&`/`||` has already decided get a safe operand
+#define DEFINE_GUARDED_BINOP_KERNEL(lane, value_type, binop, expression)                       \
+KERNEL_TARGETS                                                                                 \
+static void kernel_##lane##_binop_##binop(value_type *restrict left,                           \
+                                          const value_type *restrict right,                    \
+                                          const uint8_t *restrict active, size_t n) {          \
+    for (size_t i = 0; i < n; i++) {                                                           \
+        const value_type l = left[i], r = active == NULL || active[i] ? right[i] : 1;          \
+        left[i] = (expression);                                                                \
+    }                                                                                          \
+}
+
+#define DEFINE_GUARDED_UNOP_KERNEL(lane, value_type, unop, expression)                         \
+KERNEL_TARGETS                                                                                 \
+static void kernel_##lane##_unop_##unop(value_type *restrict operand,                          \
+                                        const uint8_t *restrict active, size_t n) {            \
+    for (size_t i = 0; i < n; i++) {                                                           \
+        const value_type x = active == NULL || active[i] ? operand[i] : 0;                     \
+        operand[i] = (expression);                                                             \
+    }                                                                                          \
+}
+
+// One scratch block is big enough for COLUMN_BLOCK values of any lane
+#define SCRATCH_BLOCK (COLUMN_BLOCK * sizeof(int64_t))
+#define LANE_COUNT (WIDTH_INT64 + 1)
+
+// Pre-order, one entry per node: the lane width the node is computed in,
+// its first operand follows it and right is the offset of the second one
+struct lane_plan {
+    enum range_width width;
+    size_t right;
+};
+
+typedef void (block_evaluator)(const struct lane_plan *plan, struct AST *ast, const struct columns *cols,
+                               size_t offset, size_t n, void *out, char *scratch,
+                               const uint8_t *active, uint8_t *masks);
+
+static block_evaluator *block_evaluators[LANE_COUNT];
+
+// Result goes to out in the node's lane. Operands computed in another lane are converted,
+// so each level of the tree uses up to two scratch blocks and one mask block.
+// active marks the lanes calc_ast would evaluate, NULL means all of them.
+// +, - and * run in wrap_type: lanes masked out by `&&`/`||` may leave the analysed range
+// and must wrap rather than overflow; int8 and int16 are promoted to int, which cannot.
+#define DEFINE_LANE_EVALUATOR(lane, value_type, wrap_type, lane_width)                         \
+DEFINE_BINOP_KERNEL(lane, value_type, add, (wrap_type) l + (wrap_type) r)                      \
+DEFINE_BINOP_KERNEL(lane, value_type, sub, (wrap_type) l - (wrap_type) r)                      \
+DEFINE_BINOP_KERNEL(lane, value_type, mul, (wrap_type) l * (wrap_type) r)                      \
+DEFINE_BINOP_KERNEL(lane, value_type, and, (l != 0) & (r != 0))                                \
+DEFINE_BINOP_KERNEL(lane, value_type, or, (l != 0) | (r != 0))                                 \
+DEFINE_BINOP_KERNEL(lane, value_type, implication, (l == 0) | (r != 0))                        \
+DEFINE_BINOP_KERNEL(lane, value_type, bicondition, (l != 0) == (r != 0))                       \
+/* No SIMD integer division: these stay scalar */                                              \
+DEFINE_GUARDED_BINOP_KERNEL(lane, value_type, div, l / r)                                      \
+DEFINE_GUARDED_BINOP_KERNEL(lane, value_type, mod, l % r)                                      \
+DEFINE_UNOP_KERNEL(lane, value_type, neg, -(wrap_type) x)                                      \
+DEFINE_UNOP_KERNEL(lane, value_type, negl, x == 0)                                             \
+DEFINE_GUARDED_UNOP_KERNEL(lane, value_type, fact, factorial(x))                               \
+                                                                                               \
+typedef void (binop_kernel_##lane)(value_type *restrict, const value_type *restrict,           \
+                                   const uint8_t *restrict, size_t);                           \
+typedef void (unop_kernel_##lane)(value_type *restrict, const uint8_t *restrict, size_t);      \
+                                                                                               \
+static binop_kernel_##lane *binop_kernels_##lane[] = {                                         \
+        [BIN_PLUS] = kernel_##lane##_binop_add,                                                \
+        [BIN_MINUS] = kernel_##lane##_binop_sub,                                               \
+        [BIN_MUL] = kernel_##lane##_binop_mul,                                                 \
+        [BIN_DIV] = kernel_##lane##_binop_div,                                                 \
+        [BIN_MOD] = kernel_##lane##_binop_mod,                                                 \
+        [BIN_AND] = kernel_##lane##_binop_and,                                                 \
+        [BIN_OR]  = kernel_##lane##_binop_or,                                                  \
+        [BIN_IMPL] = kernel_##lane##_binop_implication,                                        \
+        [BIN_BIC] = kernel_##lane##_binop_bicondition                                          \
+};                                                                                             \
+                                                                                               \
+static unop_kernel_##lane *unop_kernels_##lane[] = {                                           \
+        [UN_NEG] = kernel_##lane##_unop_neg,                                                   \
+        [UN_FACT] = kernel_##lane##_unop_fact,                                                 \
+        [UN_NEGL] = kernel_##lane##_unop_negl                                                  \
+};                                                                                             \
+                                                                                               \
+static void convert_to_##lane(enum range_width from, const void *in, value_type *out,          \
+                              size_t n) {                                                      \
+    switch (from) {                                                                            \
+        case WIDTH_BOOL: CONVERT_BLOCK(int8_t, in, out, n); break;                             \
+        case WIDTH_INT16: CONVERT_BLOCK(int16_t, in, out, n); break;                           \
+        case WIDTH_INT32: CONVERT_BLOCK(int32_t, in, out, n); break;                           \
+        case WIDTH_INT64: CONVERT_BLOCK(int64_t, in, out, n); break;                           \
+    }                                                                                          \
+}                                                                                              \
+                                                                                               \
+static void eval_block_##lane(const struct lane_plan *plan, struct AST *ast,                   \
+                              const struct columns *cols, size_t offset, size_t n,             \
+                              void *out, char *scratch,                                        \
+                              const uint8_t *active, uint8_t *masks);                          \
+                                                                                               \
+static void eval_operand_##lane(const struct lane_plan *plan, struct AST *ast,                 \
+                                const struct columns *cols, size_t offset, size_t n,           \
+                                value_type *out, char *scratch,                                \
+                                const uint8_t *active, uint8_t *masks) {                       \
+    if (plan->width == lane_width) {                                                           \
+        eval_block_##lane(plan, ast, cols, offset, n, out, scratch, active, masks);            \
+        return;                                                                                \
+    }                                                                                          \
+    block_evaluators[plan->width](plan, ast, cols, offset, n,                                  \
+                                  scratch, scratch + SCRATCH_BLOCK, active, masks);            \
+    convert_to_##lane(plan->width, scratch, out, n);                                           \
+}                                                                                              \
+                                                                                               \
+static void eval_block_##lane(const struct lane_plan *plan, struct AST *ast,                   \
+                              const struct columns *cols, size_t offset, size_t n,             \
+                              void *block, char *scratch,                                      \
+                              const uint8_t *active, uint8_t *masks) {                         \
+    value_type *const out = block;                                                             \
+    if (ast == NULL) {                                                                         \
+        memset(out, 0, n * sizeof(value_type));                                                \
+        return;                                                                                \
+    }                                                                                          \
+    switch (ast->type) {                                                                       \
+        case AST_LIT:                                                                          \
+            for (size_t i = 0; i < n; i++)                                                     \
+                out[i] = (value_type) ast->as_literal.value;                                   \
+            break;                                                                             \
+        case AST_VAR:                                                                          \
+            if (ast->as_var.index < cols->count) {                                             \
+                const int64_t *column = cols->data[ast->as_var.index] + offset;                \
+                for (size_t i = 0; i < n; i++)                                                 \
+                    out[i] = (value_type) column[i];                                           \
+            } else                                                                             \
+                memset(out, 0, n * sizeof(value_type));                                        \
+            break;                                                                             \
+        case AST_UNOP:                                                                         \
+            eval_operand_##lane(plan + 1, ast->as_unop.operand, cols, offset, n, out,          \
+                                scratch, active, masks);                                       \
+            unop_kernels_##lane[ast->as_unop.type](out, active, n);                            \
+            break;                                                                             \
+        case AST_BINOP: {                                                                      \
+            value_type *const right = (value_type *) scratch;                                  \
+            eval_operand_##lane(plan + 1, ast->as_binop.left, cols, offset, n, out,            \
+                                scratch, active, masks);                                       \
+            if (ast->as_binop.type == BIN_AND || ast->as_binop.type == BIN_OR) {               \
+                /* calc_ast skips the right operand once the left one decides */               \
+                const bool needs_right = ast->as_binop.type == BIN_AND;                        \
+                for (size_t i = 0; i < n; i++)                                                 \
+                    masks[i] = (active == NULL || active[i]) & ((out[i] != 0) == needs_right); \
+                eval_operand_##lane(plan + plan->right, ast->as_binop.right, cols, offset, n,  \
+                                    right, scratch + SCRATCH_BLOCK,                            \
+                                    masks, masks + COLUMN_BLOCK);                              \
+            } else                                                                             \
+                eval_operand_##lane(plan + plan->right, ast->as_binop.right, cols, offset, n,  \
+                                    right, scratch + SCRATCH_BLOCK, active, masks);            \
+            binop_kernels_##lane[ast->as_binop.type](out, right, active, n);                   \
+            break;                                                                             \
+        }                                                                                      \
+    }                                                                                          \
+}
+
+#define CONVERT_BLOCK(from_type, in, out, n)                                                   \
+    for (size_t i = 0; i < (n); i++)                                                           \
+        (out)[i] = ((const from_type *) (in))[i]
+
+DEFINE_LANE_EVALUATOR(int8, int8_t, int8_t, WIDTH_BOOL)
+DEFINE_LANE_EVALUATOR(int16, int16_t, int16_t, WIDTH_INT16)
+DEFINE_LANE_EVALUATOR(int32, int32_t, uint32_t, WIDTH_INT32)
+DEFINE_LANE_EVALUATOR(int64, int64_t, uint64_t, WIDTH_INT64)
+
+#undef CONVERT_BLOCK
+#undef DEFINE_LANE_EVALUATOR
+#undef DEFINE_GUARDED_UNOP_KERNEL
+#undef DEFINE_GUARDED_BINOP_KERNEL
+#undef DEFINE_UNOP_KERNEL
+#undef DEFINE_BINOP_KERNEL
+#undef KERNEL_TARGETS
+
+static block_evaluator *block_evaluators[LANE_COUNT] = {
+        [WIDTH_BOOL] = eval_block_int8,
+        [WIDTH_INT16] = eval_block_int16,
+        [WIDTH_INT32] = eval_block_int32,
+        [WIDTH_INT64] = eval_block_int64
+};
+
+static size_t ast_height(struct AST *ast) {
+    size_t left, right;
+    if (ast == NULL)
+        return 0;
+    switch (ast->type) {
+        case AST_BINOP:
+            left = ast_height(ast->as_binop.left);
+            right = ast_height(ast->as_binop.right);
+            return 1 + (left > right ? left : right);
+        case AST_UNOP:
+            return 1 + ast_height(ast->as_unop.operand);
+        default:
+            return 1;
+    }
+}
+
+static size_t ast_size(struct AST *ast) {
+    if (ast == NULL)
+        return 1;
+    switch (ast->type) {
+        case AST_BINOP:
+            return 1 + ast_size(ast->as_binop.left) + ast_size(ast->as_binop.right);
+        case AST_UNOP:
+            return 1 + ast_size(ast->as_unop.operand);
+        default:
+            return 1;
+    }
+}
+
+static enum range_width wider(enum range_width a, enum range_width b) {
+    return a > b ? a : b;
+}
+
+// A node's lane holds its own values and those of its operands, so a wide
+// subtree does not widen its siblings or its ancestors. Returns the node's range
+static struct range plan_lanes(struct AST *ast, const struct range *vars, size_t count,
+                               struct lane_plan *plan, size_t *size) {
+    struct range result, l, r;
+    size_t left_size = 0, right_size = 0;
+    plan->right = 0;
+    if (ast != NULL && ast->type == AST_UNOP) {
+        l = plan_lanes(ast->as_unop.operand, vars, count, plan + 1, &left_size);
+        result = range_unop(ast->as_unop.type, l);
+        plan->width = wider(result.width, l.width);
+    } else if (ast != NULL && ast->type == AST_BINOP) {
+        l = plan_lanes(ast->as_binop.left, vars, count, plan + 1, &left_size);
+        r = plan_lanes(ast->as_binop.right, vars, count, plan + 1 + left_size, &right_size);
+        result = range_binop(ast->as_binop.type, l, r);
+        plan->width = wider(result.width, wider(l.width, r.width));
+        plan->right = 1 + left_size;
+    } else {
+        result = ast_range(ast, vars, count);
+        plan->width = result.width;
+    }
+    *size = 1 + left_size + right_size;
+    return result;
+}
+
+static struct range column_range(const int64_t *column, size_t rows) {
+    int64_t lo = INT64_MAX, hi = INT64_MIN;
+    for (size_t i = 0; i < rows; i++) {
+        lo = column[i] < lo ? column[i] : lo;
+        hi = column[i] > hi ? column[i] : hi;
+    }
+    return rows ? range_of(lo, hi) : range_of(0, 0);
+}
+
+void calc_ast_columns(struct AST *ast, const struct columns *cols, int64_t *out) {
+    struct range *ranges = calloc(cols->count, sizeof(struct range));
+    struct lane_plan *plan = malloc(ast_size(ast) * sizeof(struct lane_plan));
+    size_t size;
+    for (size_t i = 0; i < cols->count; i++)
+        ranges[i] = column_range(cols->data[i], cols->rows);
+    plan_lanes(ast, ranges, cols->count, plan, &size);
+    free(ranges);
+
+    const size_t height = ast_height(ast);
+    char *block = malloc((2 * height + 2) * SCRATCH_BLOCK);
+    uint8_t *masks = malloc((height + 1) * COLUMN_BLOCK);
+    for (size_t offset = 0; offset < cols->rows; offset += COLUMN_BLOCK) {
+        const size_t n = cols->rows - offset < COLUMN_BLOCK ?
+                         cols->rows - offset : COLUMN_BLOCK;
+        block_evaluators[plan->width](plan, ast, cols, offset, n, block, block + SCRATCH_BLOCK,
+                                     NULL, masks);
+        convert_to_int64(plan->width, block, out + offset, n);
+    }
+    free(masks);
+    free(block);
+    free(plan);
+}
+
+#undef LANE_COUNT
+#undef SCRATCH_BLOCK
+
+// LOADERS
+
+static bool push_row(struct columns *cols, size_t *capacity, const int64_t *row) {
+    if (cols->rows == *capacity) {
+        *capacity = *capacity ? *capacity * 2 : COLUMN_BLOCK;
+        for (size_t i = 0; i < cols->count; i++) {
+            int64_t *data = realloc(cols->data[i], *capacity * sizeof(int64_t));
+            if (data == NULL)
+                return false;
+            cols->data[i] = data;
+        }
+    }
+    for (size_t i = 0; i < cols->count; i++)
+        cols->data[i][cols->rows] = row[i];
+    cols->rows++;
+    return true;
+}
+
+static size_t parse_csv_row(char *line, int64_t *row, size_t max) {
+    size_t count = 0;
+    char *end;
+    while (count < max) {
+        row[count++] = strtoll(line, &end, 10);
+        if (end == line)
+            return 0;
+        while (isspace(*end))
+            end++;
+        if (*end != ',')
+            return *end == '\0' ? count : 0;
+        line = end + 1;
+    }
+    return 0;
+}
+
+#define MAX_CSV_LINE 4096
+#define MAX_CSV_COLUMNS 256
+
+bool load_csv_columns(FILE *f, struct columns *cols) {
+    char line[MAX_CSV_LINE];
+    int64_t row[MAX_CSV_COLUMNS];
+    size_t capacity = 0;
+    bool first = true;
+
+    *cols = (struct columns) {0, 0, NULL};
+    while (fgets(line, MAX_CSV_LINE, f) != NULL) {
+        if (line[strspn(line, " \t\r\n")] == '\0')
+            continue;
+        size_t count = parse_csv_row(line, row, MAX_CSV_COLUMNS);
+        if (first) {
+            first = false;
+            if (count == 0)
+                continue;
+        }
+        if (count == 0 || (cols->data != NULL && count != cols->count)) {
+            free_columns(cols);
+            return false;
+        }
+        if (cols->data == NULL) {
+            cols->data = calloc(count, sizeof(int64_t *));
+            if (cols->data == NULL)
+                return false;
+            cols->count = count;
+        }
+        if (!push_row(cols, &capacity, row)) {
+            free_columns(cols);
+            return false;
+        }
+    }
+    return true;
+}
+
+#undef MAX_CSV_LINE
+#undef MAX_CSV_COLUMNS
+
+bool load_bin_columns(FILE *f, struct columns *cols) {
+    uint64_t header[2];
+
+    *cols = (struct columns) {0, 0, NULL};
+    if (fread(header, sizeof(uint64_t), 2, f) != 2)
+        return false;
+    // The header is untrusted: sizes must not overflow the allocations below
+    if (header[0] > SIZE_MAX / sizeof(int64_t) || header[1] > SIZE_MAX / sizeof(int64_t *))
+        return false;
+    cols->rows = header[0];
+    cols->count = header[1];
+    cols->data = calloc(cols->count, sizeof(int64_t *));
+    if (cols->data == NULL && cols->count != 0) {
+        cols->count = 0;
+        return false;
+    }
+    for (size_t i = 0; i < cols->count; i++) {
+        cols->data[i] = malloc(cols->rows * sizeof(int64_t));
+        if (cols->data[i] == NULL ||
+            fread(cols->data[i], sizeof(int64_t), cols->rows, f) != cols->rows) {
+            free_columns(cols);
+            return false;
+        }
+    }
+    return true;
+}
+
+void free_columns(struct columns *cols) {
+    for (size_t i = 0; i < cols->count && cols->data != NULL; i++)
+        free(cols->data[i]);
+    free(cols->data);
+    *cols = (struct columns) {0, 0, NULL};
+}
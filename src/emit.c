@@ -0,0 +1,132 @@
+/* emit.c */
+
+#include "../include/emit.h"
+
+// Largest n with n! representable in int64_t
+#define FACT_TABLE_SIZE 21
+// 66! has 64 factors of two, so from here on n! wraps around to 0
+#define FACT_WRAPS_TO_ZERO 66
+
+struct template {
+    const char *prefix, *infix, *suffix;
+};
+
+// `&&`/`||` keep C short-circuit as in calc_ast; `->`/`<->` evaluate both sides.
+// Logical operands are compared with 0 explicitly, so `a * b && c` compiles cleanly
+static const struct template BINOP_TEMPLATES[] = {
+        [BIN_PLUS] = {"(", " + ", ")"},
+        [BIN_MINUS] = {"(", " - ", ")"},
+        [BIN_MUL] = {"(", " * ", ")"},
+        [BIN_DIV] = {"(", " / ", ")"},
+        [BIN_MOD] = {"(", " % ", ")"},
+        [BIN_AND] = {"(int64_t)((", ") != 0 && (", ") != 0)"},
+        [BIN_OR]  = {"(int64_t)((", ") != 0 || (", ") != 0)"},
+        [BIN_IMPL] = {"impl_(", ", ", ")"},
+        [BIN_BIC]  = {"bicond_(", ", ", ")"}
+};
+
+static const struct template UNOP_TEMPLATES[] = {
+        [UN_NEG] = {"(-", "", ")"},
+        [UN_FACT] = {"fact_(", "", ")"},
+        [UN_NEGL] = {"(int64_t)((", "", ") == 0)"}
+};
+
+typedef void(emitter)(FILE *, struct AST *);
+
+static void emit_expression(FILE *f, struct AST *ast);
+
+static void emit_binop(FILE *f, struct AST *ast) {
+    const struct template t = BINOP_TEMPLATES[ast->as_binop.type];
+    fprintf(f, "%s", t.prefix);
+    emit_expression(f, ast->as_binop.left);
+    fprintf(f, "%s", t.infix);
+    emit_expression(f, ast->as_binop.right);
+    fprintf(f, "%s", t.suffix);
+}
+
+static void emit_unop(FILE *f, struct AST *ast) {
+    const struct template t = UNOP_TEMPLATES[ast->as_unop.type];
+    fprintf(f, "%s", t.prefix);
+    emit_expression(f, ast->as_unop.operand);
+    fprintf(f, "%s", t.suffix);
+}
+
+static void emit_lit(FILE *f, struct AST *ast) {
+    fprintf(f, "INT64_C(%" PRId64 ")", ast->as_literal.value);
+}
+
+static void emit_var(FILE *f, struct AST *ast) {
+    fprintf(f, "vars[%zu]", ast->as_var.index);
+}
+
+static emitter *emitters[] = {
+        [AST_BINOP] = emit_binop, [AST_UNOP] = emit_unop, [AST_LIT] = emit_lit, [AST_VAR] = emit_var};
+
+static void emit_expression(FILE *f, struct AST *ast) {
+    if (ast)
+        emitters[ast->type](f, ast);
+    else
+        fprintf(f, "INT64_C(0)");
+}
+
+static void emit_prelude(FILE *f) {
+    fprintf(f, "/* Generated by parser --emit-c */\n\n");
+    fprintf(f, "#include <stddef.h>\n#include <stdint.h>\n\n");
+
+    fprintf(f, "typedef int64_t (*formula)(const int64_t *vars);\n\n");
+    fprintf(f, "extern const size_t formulas_count;\n");
+    fprintf(f, "extern const formula formulas[];\n");
+    fprintf(f, "int64_t formula_eval(size_t id, const int64_t *vars);\n\n");
+
+    fprintf(f, "static const int64_t FACTORIALS[%d] = {", FACT_TABLE_SIZE);
+    for (int64_t i = 0; i < FACT_TABLE_SIZE; i++)
+        fprintf(f, "%sINT64_C(%" PRId64 ")", i ? ", " : "", factorial(i));
+    fprintf(f, "};\n\n");
+
+    // Past the table calc_ast wraps around; negative operands never terminate there
+    fprintf(f, "static inline int64_t fact_(int64_t n) {\n");
+    fprintf(f, "    if (n >= 0 && n < %d)\n", FACT_TABLE_SIZE);
+    fprintf(f, "        return FACTORIALS[n];\n");
+    fprintf(f, "    if (n >= %d)\n", FACT_WRAPS_TO_ZERO);
+    fprintf(f, "        return 0;\n");
+    fprintf(f, "    uint64_t result = (uint64_t) FACTORIALS[%d];\n", FACT_TABLE_SIZE - 1);
+    fprintf(f, "    for (int64_t i = %d; i <= n; i++)\n", FACT_TABLE_SIZE);
+    fprintf(f, "        result *= (uint64_t) i;\n");
+    fprintf(f, "    return n < 0 ? 0 : (int64_t) result;\n");
+    fprintf(f, "}\n\n");
+
+    fprintf(f, "static inline int64_t impl_(int64_t left, int64_t right) {\n");
+    fprintf(f, "    return !left || right;\n");
+    fprintf(f, "}\n\n");
+    fprintf(f, "static inline int64_t bicond_(int64_t left, int64_t right) {\n");
+    fprintf(f, "    return (!left || right) && (!right || left);\n");
+    fprintf(f, "}\n\n");
+}
+
+void emit_c(FILE *f, struct AST **asts, size_t count) {
+    emit_prelude(f);
+
+    for (size_t i = 0; i < count; i++) {
+        fprintf(f, "/* ");
+        print_ast(f, asts[i]);
+        fprintf(f, " */\n");
+        fprintf(f, "static inline int64_t f_%zu(const int64_t *vars) {\n", i);
+        fprintf(f, "    (void) vars;\n");
+        fprintf(f, "    return ");
+        emit_expression(f, asts[i]);
+        fprintf(f, ";\n}\n\n");
+    }
+
+    fprintf(f, "const size_t formulas_count = %zu;\n\n", count);
+    fprintf(f, "const formula formulas[] = {\n");
+    for (size_t i = 0; i < count; i++)
+        fprintf(f, "        f_%zu,\n", i);
+    fprintf(f, "};\n\n");
+
+    fprintf(f, "int64_t formula_eval(size_t id, const int64_t *vars) {\n");
+    fprintf(f, "    return id < formulas_count ? formulas[id](vars) : 0;\n");
+    fprintf(f, "}\n");
+}
+
+#undef FACT_WRAPS_TO_ZERO
+#undef FACT_TABLE_SIZE
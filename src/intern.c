@@ -0,0 +1,171 @@
+/* intern.c */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/intern.h"
+
+#define INITIAL_TABLE_SIZE 1024
+
+void intern_init(struct intern_store *store) {
+    *store = (struct intern_store) {0};
+    store->table_size = INITIAL_TABLE_SIZE;
+    store->table = calloc(store->table_size, sizeof(uint32_t));
+}
+
+void intern_free(struct intern_store *store) {
+    free(store->nodes);
+    free(store->table);
+    free(store->values);
+    free(store->stamps);
+    *store = (struct intern_store) {0};
+}
+
+// HASHING
+
+static size_t hash_node(struct intern_node node) {
+    uint64_t h = (uint64_t) node.value;
+    h ^= ((uint64_t) node.type << 56) ^ ((uint64_t) node.op << 48) ^ (h >> 29);
+    h *= 0xbf58476d1ce4e5b9ULL;
+    h ^= h >> 32;
+    return (size_t) h;
+}
+
+static bool same_node(struct intern_node a, struct intern_node b) {
+    return a.type == b.type && a.op == b.op && a.value == b.value;
+}
+
+static void table_insert(uint32_t *table, size_t size, const struct intern_node *nodes, uint32_t id) {
+    size_t slot = hash_node(nodes[id]) & (size - 1);
+    while (table[slot] != 0)
+        slot = (slot + 1) & (size - 1);
+    table[slot] = id + 1;
+}
+
+static void table_grow(struct intern_store *store) {
+    const size_t size = store->table_size * 2;
+    uint32_t *table = calloc(size, sizeof(uint32_t));
+    for (uint32_t id = 0; id < store->count; id++)
+        table_insert(table, size, store->nodes, id);
+    free(store->table);
+    store->table = table;
+    store->table_size = size;
+}
+
+static uint32_t intern_node(struct intern_store *store, struct intern_node node) {
+    size_t slot = hash_node(node) & (store->table_size - 1);
+    while (store->table[slot] != 0) {
+        const uint32_t id = store->table[slot] - 1;
+        if (same_node(store->nodes[id], node))
+            return id;
+        slot = (slot + 1) & (store->table_size - 1);
+    }
+
+    if (store->count == store->capacity) {
+        store->capacity = store->capacity ? store->capacity * 2 : INITIAL_TABLE_SIZE;
+        store->nodes = realloc(store->nodes, store->capacity * sizeof(struct intern_node));
+        store->values = realloc(store->values, store->capacity * sizeof(int64_t));
+        store->stamps = realloc(store->stamps, store->capacity * sizeof(uint32_t));
+    }
+    const uint32_t id = store->count++;
+    store->nodes[id] = node;
+    store->stamps[id] = 0;
+    store->table[slot] = id + 1;
+    if (store->count * 2 > store->table_size)
+        table_grow(store);
+    return id;
+}
+
+// Children are interned first, so they always get smaller ids
+uint32_t intern_ast(struct intern_store *store, struct AST *ast) {
+    struct intern_node node = {.type = AST_LIT, .value = 0};
+    store->seen++;
+    if (ast == NULL)
+        return intern_node(store, node);
+    node.type = ast->type;
+    switch (ast->type) {
+        case AST_LIT:
+            node.value = ast->as_literal.value;
+            break;
+        case AST_VAR:
+            node.value = (int64_t) ast->as_var.index;
+            break;
+        case AST_UNOP:
+            node.op = ast->as_unop.type;
+            node.children.left = intern_ast(store, ast->as_unop.operand);
+            node.children.right = 0;
+            break;
+        case AST_BINOP:
+            node.op = ast->as_binop.type;
+            node.children.left = intern_ast(store, ast->as_binop.left);
+            node.children.right = intern_ast(store, ast->as_binop.right);
+            break;
+    }
+    return intern_node(store, node);
+}
+
+// EVALUATION
+
+static int64_t eval_node(struct intern_store *store, uint32_t id,
+                         const int64_t *vars, size_t vars_count);
+
+static int64_t eval_unop(struct intern_store *store, struct intern_node node,
+                         const int64_t *vars, size_t vars_count) {
+    return calc_unop_int64(node.op, eval_node(store, node.children.left, vars, vars_count));
+}
+
+// `&&` and `||` skip the right operand exactly when calc_ast does
+static int64_t eval_binop(struct intern_store *store, struct intern_node node,
+                          const int64_t *vars, size_t vars_count) {
+    const int64_t l = eval_node(store, node.children.left, vars, vars_count);
+    if (node.op == BIN_AND && !l) return 0;
+    if (node.op == BIN_OR && l) return 1;
+    return calc_binop_int64(node.op, l, eval_node(store, node.children.right, vars, vars_count));
+}
+
+static int64_t eval_node(struct intern_store *store, uint32_t id,
+                         const int64_t *vars, size_t vars_count) {
+    if (store->stamps[id] == store->epoch)
+        return store->values[id];
+
+    const struct intern_node node = store->nodes[id];
+    int64_t value = 0;
+    switch (node.type) {
+        case AST_LIT:
+            value = node.value;
+            break;
+        case AST_VAR:
+            value = vars && (size_t) node.value < vars_count ? vars[node.value] : 0;
+            break;
+        case AST_UNOP:
+            value = eval_unop(store, node, vars, vars_count);
+            break;
+        case AST_BINOP:
+            value = eval_binop(store, node, vars, vars_count);
+            break;
+    }
+    store->values[id] = value;
+    store->stamps[id] = store->epoch;
+    return value;
+}
+
+void intern_eval(struct intern_store *store, const uint32_t *roots, size_t count,
+                 const int64_t *vars, size_t vars_count, int64_t *out) {
+    if (++store->epoch == 0) {
+        memset(store->stamps, 0, store->count * sizeof(uint32_t));
+        store->epoch = 1;
+    }
+    for (size_t i = 0; i < count; i++)
+        out[i] = eval_node(store, roots[i], vars, vars_count);
+}
+
+void intern_print_stats(FILE *f, const struct intern_store *store) {
+    const size_t tree_bytes = store->seen * sizeof(struct AST);
+    const size_t store_bytes = store->count * (sizeof(struct intern_node) + sizeof(int64_t) + sizeof(uint32_t)) +
+                               store->table_size * sizeof(uint32_t);
+    fprintf(f, "Nodes: %zu -> %zu unique (%.1fx)\n", store->seen, store->count,
+            store->count ? (double) store->seen / store->count : 0.0);
+    fprintf(f, "Memory: %zu -> %zu bytes\n", tree_bytes, store_bytes);
+}
+
+#undef INITIAL_TABLE_SIZE
@@ -1,24 +1,332 @@
 /* main.c */
 
+#include <ctype.h>
+#include <errno.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "../include/ast.h"
 #include "../include/ring.h"
 #include "../include/tokenizer.h"
 #include "../include/builder.h"
+#include "../include/column.h"
+#include "../include/emit.h"
+#include "../include/intern.h"
+#include "../include/pipeline.h"
 
+#define MAX_LEN 1024
 
+static bool read_line(char *str, FILE *f) {
+    if (fgets(str, MAX_LEN, f) == NULL)
+        return false;
+    if (str[strlen(str) - 1] == '\n')
+        str[strlen(str) - 1] = '\0';
+    return true;
+}
+
+typedef bool (column_loader)(FILE *f, struct columns *cols);
+
+static int run_columns(char *str, const char *path, column_loader *loader) {
+    struct AST *ast = build_ast_tokens(tokenize(str));
+    if (ast == NULL) {
+        printf("AST build error.\n");
+        return 1;
+    }
+
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        printf("Can't open %s.\n", path);
+        return 1;
+    }
+    struct columns cols;
+    bool loaded = loader(f, &cols);
+    fclose(f);
+    if (!loaded) {
+        printf("Can't load columns from %s.\n", path);
+        return 1;
+    }
+
+    int64_t *out = malloc(cols.rows * sizeof(int64_t));
+    calc_ast_columns(ast, &cols, out);
+    for (size_t i = 0; i < cols.rows; i++)
+        printf("%" PRId64 "\n", out[i]);
+
+    free(out);
+    free_columns(&cols);
+    return 0;
+}
+
+// One expression per non-blank line of stdin, C source to stdout
+static int run_emit(void) {
+    char str[MAX_LEN];
+    size_t count = 0, capacity = 0;
+    struct AST **asts = NULL;
+
+    while (read_line(str, stdin)) {
+        if (str[strspn(str, " \t\r")] == '\0')
+            continue;
+        struct AST *ast = build_ast_tokens(tokenize(str));
+        if (ast == NULL) {
+            fprintf(stderr, "AST build error in formula %zu: %s\n", count, str);
+            free(asts);
+            return 1;
+        }
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 16;
+            asts = realloc(asts, capacity * sizeof(struct AST *));
+        }
+        asts[count++] = ast;
+    }
+    if (count == 0) {
+        fprintf(stderr, "Input is empty!\n");
+        return 1;
+    }
+
+    emit_c(stdout, asts, count);
+    free(asts);
+    return 0;
+}
+
+// One expression per line of stdin, one line of results per CSV row to stdout
+static int run_batch(const char *path) {
+    char str[MAX_LEN];
+    size_t count = 0, capacity = 0;
+    uint32_t *roots = NULL;
+    struct intern_store store;
+    struct columns cols = {1, 0, NULL};
+
+    if (path != NULL) {
+        FILE *f = fopen(path, "rb");
+        if (f == NULL || !load_csv_columns(f, &cols)) {
+            fprintf(stderr, "Can't load columns from %s.\n", path);
+            if (f != NULL)
+                fclose(f);
+            return 1;
+        }
+        fclose(f);
+    }
+
+    intern_init(&store);
+    while (read_line(str, stdin)) {
+        if (str[strspn(str, " \t\r")] == '\0')
+            continue;
+        struct AST *ast = build_ast_tokens(tokenize(str));
+        if (ast == NULL) {
+            fprintf(stderr, "AST build error in formula %zu: %s\n", count, str);
+            intern_free(&store);
+            free(roots);
+            return 1;
+        }
+        if (count == capacity) {
+            capacity = capacity ? capacity * 2 : 16;
+            roots = realloc(roots, capacity * sizeof(uint32_t));
+        }
+        roots[count++] = intern_ast(&store, ast);
+        free_ast(ast);
+    }
+
+    int64_t *vars = malloc(cols.count * sizeof(int64_t));
+    int64_t *out = malloc(count * sizeof(int64_t));
+    for (size_t row = 0; row < cols.rows; row++) {
+        for (size_t i = 0; i < cols.count; i++)
+            vars[i] = cols.data[i][row];
+        intern_eval(&store, roots, count, vars, cols.count, out);
+        for (size_t i = 0; i < count; i++)
+            printf("%s%" PRId64, i ? "," : "", out[i]);
+        printf("\n");
+    }
+
+    fprintf(stderr, "Formulas: %zu\n", count);
+    intern_print_stats(stderr, &store);
+    free(vars);
+    free(out);
+    free(roots);
+    free_columns(&cols);
+    intern_free(&store);
+    return 0;
+}
+
+// VALUE DOMAINS
 
-int main() {
+static bool parse_int64(char *str, char **end, int64_t *value) {
+    errno = 0;
+    *value = strtoll(str, end, 10);
+    return *end != str && errno == 0;
+}
+
+static bool parse_int32(char *str, char **end, int32_t *value) {
+    int64_t wide;
+    if (!parse_int64(str, end, &wide) || wide < INT32_MIN || wide > INT32_MAX)
+        return false;
+    *value = (int32_t) wide;
+    return true;
+}
+
+static bool parse_double(char *str, char **end, double *value) {
+    *value = strtod(str, end);
+    return *end != str;
+}
+
+// Nonzero is true, as for literals
+static bool parse_boolean(char *str, char **end, bool *value) {
+    double real;
+    if (!parse_double(str, end, &real))
+        return false;
+    *value = real != 0;
+    return true;
+}
+
+static void format_int32(FILE *f, int32_t value) { fprintf(f, "%" PRId32, value); }
+static void format_int64(FILE *f, int64_t value) { fprintf(f, "%" PRId64, value); }
+static void format_double(FILE *f, double value) { fprintf(f, "%.15g", value); }
+static void format_boolean(FILE *f, bool value) { fprintf(f, "%s", value ? "true" : "false"); }
+
+#define MAX_CSV_COLUMNS 256
+
+// CSV rows are parsed straight into the domain type and evaluated one at a time
+#define DEFINE_DOMAIN(domain, value_type)                                            \
+static void print_##domain##_value(FILE *f, struct AST *ast) {                       \
+    format_##domain(f, calc_ast_##domain(ast, NULL, 0));                             \
+}                                                                                    \
+                                                                                     \
+static size_t parse_##domain##_row(char *line, value_type *row, size_t max) {        \
+    size_t count = 0;                                                                \
+    char *end;                                                                       \
+    while (count < max) {                                                            \
+        if (!parse_##domain(line, &end, &row[count++]))                              \
+            return 0;                                                                \
+        while (isspace(*end))                                                        \
+            end++;                                                                   \
+        if (*end != ',')                                                             \
+            return *end == '\0' ? count : 0;                                         \
+        line = end + 1;                                                              \
+    }                                                                                \
+    return 0;                                                                        \
+}                                                                                    \
+                                                                                     \
+static bool print_##domain##_rows(FILE *f, struct AST *ast, FILE *in) {              \
+    char line[MAX_LEN];                                                              \
+    value_type row[MAX_CSV_COLUMNS];                                                 \
+    size_t columns = 0;                                                              \
+    bool first = true;                                                               \
+    while (fgets(line, MAX_LEN, in) != NULL) {                                       \
+        if (line[strspn(line, " \t\r\n")] == '\0')                                   \
+            continue;                                                                \
+        size_t count = parse_##domain##_row(line, row, MAX_CSV_COLUMNS);             \
+        if (first) {                                                                 \
+            first = false;                                                           \
+            if (count == 0)                                                          \
+                continue;                                                            \
+        }                                                                            \
+        if (count == 0 || (columns != 0 && count != columns))                        \
+            return false;                                                            \
+        columns = count;                                                             \
+        format_##domain(f, calc_ast_##domain(ast, row, count));                      \
+        fprintf(f, "\n");                                                            \
+    }                                                                                \
+    return true;                                                                     \
+}
+
+DEFINE_DOMAIN(int32, int32_t)
+DEFINE_DOMAIN(int64, int64_t)
+DEFINE_DOMAIN(double, double)
+DEFINE_DOMAIN(boolean, bool)
+
+#undef DEFINE_DOMAIN
+#undef MAX_CSV_COLUMNS
+
+typedef void (value_printer)(FILE *f, struct AST *ast);
+typedef bool (rows_printer)(FILE *f, struct AST *ast, FILE *in);
+
+static const struct domain {
+    const char *name;
+    value_printer *print;
+    rows_printer *print_rows;
+} DOMAINS[] = {
+        {"int32", print_int32_value, print_int32_rows},
+        {"int64", print_int64_value, print_int64_rows},
+        {"double", print_double_value, print_double_rows},
+        {"bool", print_boolean_value, print_boolean_rows}
+};
+
+static const struct domain *find_domain(const char *name) {
+    for (size_t i = 0; i < sizeof(DOMAINS) / sizeof(DOMAINS[0]); i++)
+        if (strcmp(DOMAINS[i].name, name) == 0)
+            return &DOMAINS[i];
+    return NULL;
+}
+
+static int run_domain_rows(char *str, const char *path, const struct domain *domain) {
+    struct AST *ast = build_ast_tokens(tokenize(str));
+    if (ast == NULL) {
+        printf("AST build error.\n");
+        return 1;
+    }
+
+    FILE *f = fopen(path, "r");
+    if (f == NULL) {
+        printf("Can't open %s.\n", path);
+        free_ast(ast);
+        return 1;
+    }
+    bool printed = domain->print_rows(stdout, ast, f);
+    fclose(f);
+    free_ast(ast);
+    if (!printed) {
+        printf("Can't load %s values from %s.\n", domain->name, path);
+        return 1;
+    }
+    return 0;
+}
+
+static const char *USAGE =
+        "Usage: parser [--domain=int32|int64|double|bool [--csv <file>]]\n"
+        "       parser --csv <file> | --bin <file>\n"
+        "       parser --emit-c | --pipeline | --batch [<file>]\n";
+
+int main(int argc, char **argv) {
     //char *str = "(1+ -2 )";
-    const int MAX_LEN = 1024;
     char str[MAX_LEN];
-    if (fgets(str, MAX_LEN, stdin) == NULL) {
+    const struct domain *domain = find_domain("int64");
+    column_loader *loader = NULL;
+    const char *rows_path = NULL;
+
+    if (argc == 2 && strcmp(argv[1], "--emit-c") == 0)
+        return run_emit();
+    if (argc == 2 && strcmp(argv[1], "--pipeline") == 0)
+        return run_pipeline(stdin, stdout, stderr);
+    if (argc >= 2 && argc <= 3 && strcmp(argv[1], "--batch") == 0)
+        return run_batch(argc == 3 ? argv[2] : NULL);
+
+    if (argc >= 2 && strncmp(argv[1], "--domain=", strlen("--domain=")) == 0) {
+        if ((domain = find_domain(argv[1] + strlen("--domain="))) == NULL) {
+            printf("Unknown domain %s.\n", argv[1] + strlen("--domain="));
+            return 1;
+        }
+        if (argc == 4 && strcmp(argv[2], "--csv") == 0)
+            rows_path = argv[3];
+        else if (argc != 2) {
+            printf("Unsupported arguments.\n%s", USAGE);
+            return 1;
+        }
+    } else if (argc == 3 && strcmp(argv[1], "--csv") == 0)
+        loader = load_csv_columns;
+    else if (argc == 3 && strcmp(argv[1], "--bin") == 0)
+        loader = load_bin_columns;
+    else if (argc != 1) {
+        printf("Unsupported arguments.\n%s", USAGE);
+        return 1;
+    }
+
+    if (!read_line(str, stdin)) {
         printf("Input is empty!");
         return 0;
     }
-    if (str[strlen(str) - 1] == '\n')
-        str[strlen(str) - 1] = '\0';
+
+    if (loader)
+        return run_columns(str, argv[2], loader);
+    if (rows_path)
+        return run_domain_rows(str, rows_path, domain);
 
     struct AST *ast = build_ast(str);
 
@@ -27,10 +335,13 @@ int main() {
     else {
         printf("AST: \n");
         ast_print(*ast);
-        printf("\nInfix notation: \n%s = %" PRId64 "\n", str, calc_ast(ast));
-        printf("Reverse polish notation: \n");
+        printf("\nInfix notation: \n%s = ", str);
+        domain->print(stdout, ast);
+        printf("\nReverse polish notation: \n");
         p_print_ast(stdout, ast);
-        printf(" = %" PRId64 "\n", calc_ast(ast));
+        printf(" = ");
+        domain->print(stdout, ast);
+        printf("\n");
     }
 
     return 0;
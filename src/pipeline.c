@@ -0,0 +1,186 @@
+/* pipeline.c */
+
+// fileno is POSIX, not C17
+#define _POSIX_C_SOURCE 200809L
+
+#include <poll.h>
+#include <pthread.h>
+#include <string.h>
+
+#include "../include/ast.h"
+#include "../include/builder.h"
+#include "../include/pipeline.h"
+#include "../include/spsc.h"
+#include "../include/tokenizer.h"
+
+#define MAX_LEN 1024
+#define QUEUE_CAPACITY 1024
+#define QUEUE_BATCH 32
+
+struct item {
+    char line[MAX_LEN];
+    struct ring_token *tokens;
+    struct AST *ast;
+    int64_t value;
+};
+
+// NULL marks the end of the stream
+DECLARE_SPSC(item, struct item *)
+
+DEFINE_SPSC(item, struct item *)
+
+enum stage {
+    STAGE_TOKENIZE, STAGE_BUILD, STAGE_EVAL, STAGE_FORMAT, STAGE_COUNT
+};
+
+static const char *STAGES_STR[] = {
+        [STAGE_TOKENIZE] = "tokenize",
+        [STAGE_BUILD] = "build",
+        [STAGE_EVAL] = "evaluate",
+        [STAGE_FORMAT] = "format"
+};
+
+struct stage_context {
+    struct spsc_item *in, *out;
+    FILE *f;
+};
+
+typedef void (stage_step)(struct item *item, struct stage_context *ctx);
+
+static void step_tokenize(struct item *item, struct stage_context *ctx) {
+    item->tokens = tokenize(item->line);
+}
+
+static void step_build(struct item *item, struct stage_context *ctx) {
+    item->ast = build_ast_tokens(item->tokens);
+    item->tokens = NULL;
+}
+
+static void step_eval(struct item *item, struct stage_context *ctx) {
+    if (item->ast)
+        item->value = calc_ast(item->ast);
+}
+
+static void step_format(struct item *item, struct stage_context *ctx) {
+    if (item->ast == NULL)
+        fprintf(ctx->f, "AST build error.\n");
+    else {
+        p_print_ast(ctx->f, item->ast);
+        fprintf(ctx->f, "= %" PRId64 "\n", item->value);
+    }
+    free_ast(item->ast);
+    free(item);
+}
+
+static stage_step *stage_steps[] = {
+        [STAGE_TOKENIZE] = step_tokenize,
+        [STAGE_BUILD] = step_build,
+        [STAGE_EVAL] = step_eval,
+        [STAGE_FORMAT] = step_format
+};
+
+struct stage_thread {
+    enum stage stage;
+    struct stage_context ctx;
+};
+
+// Output is flushed before waiting on input so a partial batch never gets stuck,
+// the last stage flushes its stream for the same reason
+static void *stage_run(void *arg) {
+    struct stage_thread *thread = arg;
+    struct stage_context *ctx = &thread->ctx;
+    struct item *item;
+    for (;;) {
+        if (!spsc_item_try_pop(ctx->in, &item)) {
+            if (ctx->out)
+                spsc_item_flush(ctx->out);
+            else
+                fflush(ctx->f);
+            item = spsc_item_pop(ctx->in);
+        }
+        if (item != NULL)
+            stage_steps[thread->stage](item, ctx);
+        if (ctx->out)
+            spsc_item_push(ctx->out, item);
+        if (item == NULL)
+            break;
+    }
+    if (ctx->out)
+        spsc_item_flush(ctx->out);
+    return NULL;
+}
+
+// Streams without a descriptor count as never ready, so the caller flushes conservatively
+static bool input_ready(FILE *in) {
+    struct pollfd fd = {fileno(in), POLLIN, 0};
+    return poll(&fd, 1, 0) > 0;
+}
+
+static void print_stats(FILE *f, struct spsc_item *queues) {
+    fprintf(f, "%-10s %12s %16s %16s\n", "stage", "avg backlog", "producer stalls", "consumer stalls");
+    for (size_t i = 0; i < STAGE_COUNT; i++) {
+        const struct spsc_item *q = &queues[i];
+        fprintf(f, "%-10s %12.1f %16zu %16zu\n", STAGES_STR[i],
+                q->samples ? (double) q->occupancy / q->samples : 0.0,
+                q->producer_stalls, q->consumer_stalls);
+    }
+}
+
+// queues[i] feeds stage i, the reader is the producer of queues[0]
+int run_pipeline(FILE *in, FILE *out, FILE *stats) {
+    struct spsc_item queues[STAGE_COUNT];
+    struct stage_thread threads[STAGE_COUNT];
+    pthread_t ids[STAGE_COUNT];
+    size_t started = 0;
+    bool failed = false;
+
+    for (size_t i = 0; i < STAGE_COUNT; i++)
+        if (!spsc_item_init(&queues[i], QUEUE_CAPACITY, QUEUE_BATCH))
+            return 1;
+    for (; started < STAGE_COUNT; started++) {
+        threads[started] = (struct stage_thread) {
+                started, {&queues[started], started + 1 < STAGE_COUNT ? &queues[started + 1] : NULL, out}};
+        if (pthread_create(&ids[started], NULL, stage_run, &threads[started]) != 0) {
+            fprintf(stats, "Can't start the %s stage.\n", STAGES_STR[started]);
+            failed = true;
+            break;
+        }
+    }
+
+    // Pushes publish once per batch, a partial batch is flushed only when fgets may block
+    while (!failed) {
+        struct item *item = malloc(sizeof(struct item));
+        if (item == NULL) {
+            fprintf(stats, "Out of memory.\n");
+            failed = true;
+            break;
+        }
+        if (!input_ready(in))
+            spsc_item_flush(&queues[0]);
+        if (fgets(item->line, MAX_LEN, in) == NULL) {
+            free(item);
+            break;
+        }
+        item->line[strcspn(item->line, "\n")] = '\0';
+        item->tokens = NULL;
+        item->ast = NULL;
+        item->value = 0;
+        spsc_item_push(&queues[0], item);
+    }
+    // The end marker stops the started stages even if a later one is missing
+    spsc_item_push(&queues[0], NULL);
+    spsc_item_flush(&queues[0]);
+
+    for (size_t i = 0; i < started; i++)
+        pthread_join(ids[i], NULL);
+
+    if (!failed)
+        print_stats(stats, queues);
+    for (size_t i = 0; i < STAGE_COUNT; i++)
+        spsc_item_free(&queues[i]);
+    return failed ? 1 : 0;
+}
+
+#undef MAX_LEN
+#undef QUEUE_CAPACITY
+#undef QUEUE_BATCH
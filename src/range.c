@@ -0,0 +1,144 @@
+/* range.c */
+
+#include "../include/range.h"
+
+// Largest n with n! representable in int64_t
+#define MAX_FACT 20
+
+static const struct range UNBOUNDED = {INT64_MIN, INT64_MAX, true, WIDTH_INT64};
+static const struct range LOGICAL = {0, 1, false, WIDTH_BOOL};
+
+static enum range_width width_of(int64_t lo, int64_t hi) {
+    if (lo >= 0 && hi <= 1) return WIDTH_BOOL;
+    if (lo >= INT16_MIN && hi <= INT16_MAX) return WIDTH_INT16;
+    if (lo >= INT32_MIN && hi <= INT32_MAX) return WIDTH_INT32;
+    return WIDTH_INT64;
+}
+
+struct range range_of(int64_t lo, int64_t hi) {
+    return (struct range) {lo, hi, false, width_of(lo, hi)};
+}
+
+static int64_t min64(int64_t a, int64_t b) { return a < b ? a : b; }
+
+static int64_t max64(int64_t a, int64_t b) { return a > b ? a : b; }
+
+static bool contains(struct range r, int64_t value) {
+    return r.lo <= value && value <= r.hi;
+}
+
+// UNOP TYPE
+
+typedef struct range (unop_range)(struct range);
+
+static struct range range_unop_neg(struct range r) {
+    if (r.lo == INT64_MIN) return UNBOUNDED;
+    return range_of(-r.hi, -r.lo);
+}
+
+static struct range range_unop_fact(struct range r) {
+    if (r.lo < 0 || r.hi > MAX_FACT) return UNBOUNDED;
+    return range_of(factorial(r.lo), factorial(r.hi));
+}
+
+static struct range range_unop_negl(struct range r) {
+    return LOGICAL;
+}
+
+static unop_range *unop_ranges[] = {
+        [UN_NEG] = range_unop_neg,
+        [UN_FACT] = range_unop_fact,
+        [UN_NEGL] = range_unop_negl
+};
+
+// BINOP TYPE
+
+typedef struct range (binop_range)(struct range, struct range);
+
+static struct range range_binop_add(struct range l, struct range r) {
+    int64_t lo, hi;
+    if (__builtin_add_overflow(l.lo, r.lo, &lo) || __builtin_add_overflow(l.hi, r.hi, &hi))
+        return UNBOUNDED;
+    return range_of(lo, hi);
+}
+
+static struct range range_binop_sub(struct range l, struct range r) {
+    int64_t lo, hi;
+    if (__builtin_sub_overflow(l.lo, r.hi, &lo) || __builtin_sub_overflow(l.hi, r.lo, &hi))
+        return UNBOUNDED;
+    return range_of(lo, hi);
+}
+
+static struct range range_binop_mul(struct range l, struct range r) {
+    int64_t p[4];
+    if (__builtin_mul_overflow(l.lo, r.lo, &p[0]) || __builtin_mul_overflow(l.lo, r.hi, &p[1]) ||
+        __builtin_mul_overflow(l.hi, r.lo, &p[2]) || __builtin_mul_overflow(l.hi, r.hi, &p[3]))
+        return UNBOUNDED;
+    return range_of(min64(min64(p[0], p[1]), min64(p[2], p[3])),
+                    max64(max64(p[0], p[1]), max64(p[2], p[3])));
+}
+
+// Truncating division is monotonic in each operand while the divisor keeps its sign
+static struct range range_binop_div(struct range l, struct range r) {
+    if (contains(r, 0) || (l.lo == INT64_MIN && contains(r, -1)))
+        return UNBOUNDED;
+    const int64_t q[4] = {l.lo / r.lo, l.lo / r.hi, l.hi / r.lo, l.hi / r.hi};
+    return range_of(min64(min64(q[0], q[1]), min64(q[2], q[3])),
+                    max64(max64(q[0], q[1]), max64(q[2], q[3])));
+}
+
+// |l % r| < |r| and the result takes the sign of l
+static struct range range_binop_mod(struct range l, struct range r) {
+    if (contains(r, 0) || (l.lo == INT64_MIN && contains(r, -1)))
+        return UNBOUNDED;
+    const int64_t bound = r.lo == INT64_MIN ? INT64_MAX : max64(-r.lo, r.hi) - 1;
+    return range_of(l.lo >= 0 ? 0 : max64(l.lo, -bound),
+                    l.hi <= 0 ? 0 : min64(l.hi, bound));
+}
+
+static struct range range_binop_logical(struct range l, struct range r) {
+    return LOGICAL;
+}
+
+static binop_range *binop_ranges[] = {
+        [BIN_PLUS] = range_binop_add,
+        [BIN_MINUS] = range_binop_sub,
+        [BIN_MUL] = range_binop_mul,
+        [BIN_DIV] = range_binop_div,
+        [BIN_MOD] = range_binop_mod,
+        [BIN_AND] = range_binop_logical,
+        [BIN_OR]  = range_binop_logical,
+        [BIN_IMPL] = range_binop_logical,
+        [BIN_BIC] = range_binop_logical
+};
+
+struct range range_unop(enum unop_type type, struct range operand) {
+    return unop_ranges[type](operand);
+}
+
+struct range range_binop(enum binop_type type, struct range left, struct range right) {
+    return binop_ranges[type](left, right);
+}
+
+// AST TYPE
+
+struct range ast_range(struct AST *ast, const struct range *vars, size_t count) {
+    if (ast == NULL)
+        return range_of(0, 0);
+    switch (ast->type) {
+        case AST_LIT:
+            return range_of(ast->as_literal.value, ast->as_literal.value);
+        case AST_VAR:
+            if (vars != NULL && ast->as_var.index < count)
+                return vars[ast->as_var.index];
+            return range_of(INT64_MIN, INT64_MAX);
+        case AST_UNOP:
+            return range_unop(ast->as_unop.type, ast_range(ast->as_unop.operand, vars, count));
+        case AST_BINOP:
+            return range_binop(ast->as_binop.type, ast_range(ast->as_binop.left, vars, count),
+                               ast_range(ast->as_binop.right, vars, count));
+    }
+    return UNBOUNDED;
+}
+
+#undef MAX_FACT
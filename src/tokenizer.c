@@ -3,6 +3,7 @@
 #include <ctype.h>
 #include <string.h>
 
+#include "../include/ast.h"
 #include "../include/ring.h"
 #include "../include/tokenizer.h"
 
@@ -27,6 +28,7 @@ static const char *TOKENS[] = {
         [TOK_CLOSE] = ")",
 
         [TOK_LIT]   = "",
+        [TOK_VAR]   = "$",
         [TOK_NEG]   = "-"
 };
 
@@ -48,6 +50,7 @@ const char *TOKENS_STR[] = {
         [TOK_CLOSE] = "CLOSE",
 
         [TOK_LIT]   = "LIT",
+        [TOK_VAR]   = "VAR",
         [TOK_NEG]   = "NEG",
 
         [TOK_END]   = "END",
@@ -77,8 +80,20 @@ struct token next_token(char **str) {
     if (isdigit(*buf)) {
         char *str_end;
         int64_t tmp = strtoll(buf, &str_end, 10);
+        if (*str_end == '.' || *str_end == 'e' || *str_end == 'E') {
+            double real = strtod(buf, &str_end);
+            *str = str_end;
+            return (struct token) {TOK_LIT, truncate_real(real), real};
+        }
+        *str = str_end;
+        return (struct token) {TOK_LIT, tmp, (double) tmp};
+    }
+
+    if (*buf == '$' && isdigit(buf[1])) {
+        char *str_end;
+        int64_t tmp = strtoll(buf + 1, &str_end, 10);
         *str = str_end;
-        return (struct token) {TOK_LIT, tmp};
+        return (struct token) {TOK_VAR, tmp};
     }
 
     return (struct token) {TOK_ERROR, 0};